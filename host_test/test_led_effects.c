@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <string.h>
+#include "led_effects.h"
+#include "led_render.h"
+
+static const int s_modes[] = { 0, 1, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+#define MODE_COUNT ((int)(sizeof(s_modes) / sizeof(s_modes[0])))
+
+// Enough frames for mode 15 to get through the collision into the fireworks phase
+#define LONG_RUN_FRAMES 400
+
+static int s_failures = 0;
+
+#define CHECK(cond, ...) do {                 \
+    if (!(cond)) {                            \
+        printf("FAIL: " __VA_ARGS__);         \
+        printf("\n");                         \
+        s_failures++;                         \
+    }                                         \
+} while (0)
+
+static void test_mode_lookup(void)
+{
+    for (int i = 0; i < MODE_COUNT; i++) {
+        const led_effect_t *effect = led_effect_get(s_modes[i]);
+        CHECK(effect != NULL && effect->init && effect->step, "mode %d has no effect", s_modes[i]);
+    }
+    CHECK(led_effect_get(-1) == NULL, "mode -1 should be unknown");
+    CHECK(led_effect_get(2) == NULL, "mode 2 should be unknown");
+    CHECK(led_effect_get(16) == NULL, "mode 16 should be unknown");
+}
+
+/* init() must bring an effect back to its first frame no matter how long it ran before */
+static void test_init_resets_state(void)
+{
+    static uint8_t first[LED_NUMBER * 3];
+    static uint8_t again[LED_NUMBER * 3];
+
+    for (int i = 0; i < MODE_COUNT; i++) {
+        const led_effect_t *effect = led_effect_get(s_modes[i]);
+        memset(first, 0, sizeof(first));
+        effect->init();
+        effect->step(first);
+
+        for (int f = 0; f < LONG_RUN_FRAMES; f++) {
+            effect->step(again);
+        }
+
+        memset(again, 0, sizeof(again));
+        effect->init();
+        effect->step(again);
+        CHECK(memcmp(first, again, sizeof(first)) == 0,
+              "mode %d (%s) did not restart from its first frame", s_modes[i], effect->name);
+    }
+}
+
+/*
+ * Render loop simulation. led_renderer_run_once() runs against fake hooks on a modelled
+ * clock: a frame takes LED_STRIP_TRANSFER_US on the wire, and every step() is charged
+ * RENDER_US, a conservative figure for a 300 LED frame on the ESP32.
+ */
+#define RENDER_US       500
+#define MAX_COMMANDS    2
+
+typedef struct {
+    led_renderer_t renderer;
+    int64_t now;
+    int64_t tx_end;                 // when the last queued frame is fully on the strip
+    uint32_t frames_charged;
+    led_mode_request_t commands[MAX_COMMANDS];
+    int command_count;
+    int delivered;                  // commands[0..delivered) were taken or overwritten
+    int target;                     // mode of the last command
+    int64_t first_step_us;          // when the target mode rendered its first frame
+    int64_t shown_us;               // when that frame was fully on the strip
+    bool first_frame_fresh;
+    int reports;
+    int64_t reported_latency_us;
+    uint32_t reported_frame_ms;
+} sim_t;
+
+static uint8_t s_first_frames[MODE_COUNT][LED_NUMBER * 3];
+
+static int mode_index(int mode)
+{
+    for (int i = 0; i < MODE_COUNT; i++) {
+        if (s_modes[i] == mode) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Charge modelled time for every step() since the last hook call
+static void sim_charge(sim_t *sim)
+{
+    while (sim->frames_charged != sim->renderer.frames_rendered) {
+        if (sim->renderer.mode == sim->target && sim->first_step_us < 0 && sim->delivered > 0) {
+            sim->first_step_us = sim->now;
+        }
+        sim->now += RENDER_US;
+        sim->frames_charged++;
+    }
+}
+
+static bool sim_wait_request(void *ctx, uint32_t timeout_ms, led_mode_request_t *req)
+{
+    sim_t *sim = ctx;
+    sim_charge(sim);
+    // Commands still in the future are not visible; wake at the first one inside the timeout
+    int latest = -1;
+    for (int i = sim->delivered; i < sim->command_count; i++) {
+        if (sim->commands[i].t_us <= sim->now) {
+            latest = i;
+        }
+    }
+    if (latest < 0 && sim->delivered < sim->command_count &&
+        sim->commands[sim->delivered].t_us <= sim->now + (int64_t)timeout_ms * 1000) {
+        latest = sim->delivered;
+        sim->now = sim->commands[latest].t_us;
+    }
+    if (latest < 0) {
+        sim->now += (int64_t)timeout_ms * 1000;
+        return false;
+    }
+    // One-slot queue: a newer command overwrites the ones before it
+    *req = sim->commands[latest];
+    sim->delivered = latest + 1;
+    return true;
+}
+
+static void sim_transmit(void *ctx, const uint8_t *pixels, size_t size)
+{
+    sim_t *sim = ctx;
+    sim_charge(sim);
+    sim->tx_end = (sim->tx_end > sim->now ? sim->tx_end : sim->now) + LED_STRIP_TRANSFER_US;
+    if (sim->renderer.mode == sim->target && sim->shown_us < 0 && sim->delivered > 0) {
+        sim->shown_us = sim->tx_end;
+        sim->first_frame_fresh = memcmp(pixels, s_first_frames[mode_index(sim->target)], size) == 0;
+    }
+}
+
+static void sim_wait_done(void *ctx)
+{
+    sim_t *sim = ctx;
+    sim_charge(sim);
+    if (sim->now < sim->tx_end) {
+        sim->now = sim->tx_end;
+    }
+}
+
+static int64_t sim_now_us(void *ctx)
+{
+    sim_t *sim = ctx;
+    sim_charge(sim);
+    return sim->now;
+}
+
+static void sim_report_switch(void *ctx, int mode, int64_t latency_us, uint32_t frame_ms)
+{
+    sim_t *sim = ctx;
+    sim->reports++;
+    sim->reported_latency_us = latency_us;
+    sim->reported_frame_ms = frame_ms;
+}
+
+static const led_render_io_t s_sim_io = {
+    .wait_request = sim_wait_request,
+    .transmit = sim_transmit,
+    .wait_done = sim_wait_done,
+    .now_us = sim_now_us,
+    .report_switch = sim_report_switch,
+};
+
+// Run from mode `from` and send the given commands; the last one is the switch being timed
+static void run_switch(int from, const led_mode_request_t *commands, int count)
+{
+    static sim_t sim;
+    led_render_io_t io = s_sim_io;
+    io.ctx = &sim;
+
+    memset(&sim, 0, sizeof(sim));
+    memcpy(sim.commands, commands, count * sizeof(commands[0]));
+    sim.command_count = count;
+    sim.target = commands[count - 1].mode;
+    sim.first_step_us = -1;
+    sim.shown_us = -1;
+    led_renderer_init(&sim.renderer, &io, from);
+
+    int64_t sent_us = commands[count - 1].t_us;
+    while (sim.reports == 0 && sim.now < sent_us + 1000000) {
+        led_renderer_run_once(&sim.renderer);
+    }
+
+    CHECK(sim.reports == 1, "switch %d -> %d at %lld us was never reported",
+          from, sim.target, (long long)sent_us);
+    if (sim.reports == 0) {
+        return;
+    }
+    int64_t step_latency_us = sim.first_step_us - sent_us;
+    int64_t shown_latency_us = sim.shown_us - sent_us;
+    uint32_t frame_ms = sim.reported_frame_ms;
+
+    CHECK(sim.first_frame_fresh, "switch %d -> %d did not start from the first frame", from, sim.target);
+    CHECK(sim.reported_latency_us == shown_latency_us,
+          "switch %d -> %d reported %lld us, frame was shown after %lld us",
+          from, sim.target, (long long)sim.reported_latency_us, (long long)shown_latency_us);
+    CHECK(step_latency_us >= 0 && step_latency_us <= (int64_t)frame_ms * 1000,
+          "switch %d -> %d at %lld us: first step after %lld us, frame period is %u ms",
+          from, sim.target, (long long)sent_us, (long long)step_latency_us, (unsigned)frame_ms);
+    CHECK(shown_latency_us <= LED_SWITCH_BOUND_US(frame_ms),
+          "switch %d -> %d at %lld us: shown after %lld us, bound is %lld us",
+          from, sim.target, (long long)sent_us, (long long)shown_latency_us,
+          (long long)LED_SWITCH_BOUND_US(frame_ms));
+}
+
+static void compute_first_frames(void)
+{
+    for (int i = 0; i < MODE_COUNT; i++) {
+        const led_effect_t *effect = led_effect_get(s_modes[i]);
+        effect->init();
+        effect->step(s_first_frames[i]);
+    }
+}
+
+/*
+ * Send a command at every point of the old mode's frame cycle, for every from/to pair.
+ * The new mode must render within one frame period of the command, and be on the strip
+ * within LED_SWITCH_BOUND_US: the old frame may already be on the wire and has to finish.
+ */
+static void test_switch_latency(void)
+{
+    for (int from = 0; from < MODE_COUNT; from++) {
+        for (int to = 0; to < MODE_COUNT; to++) {
+            if (from == to) {
+                continue;
+            }
+            for (int64_t offset = 0; offset < 2 * (100000 + LED_STRIP_TRANSFER_US); offset += 251) {
+                led_mode_request_t cmd = { .mode = s_modes[to], .t_us = 50000 + offset };
+                run_switch(s_modes[from], &cmd, 1);
+            }
+        }
+    }
+}
+
+/*
+ * Re-selecting the running mode wakes the loop early, possibly while the last frame is
+ * still on the wire. A switch right after must still meet the bound. Rainbow has the
+ * shortest frame period, so it is the tightest target (and lightning when leaving it).
+ */
+static void test_switch_after_reselect(void)
+{
+    for (int from = 0; from < MODE_COUNT; from++) {
+        int to = s_modes[from] == 1 ? 12 : 1;
+        for (int64_t first = 0; first < 100000 + LED_STRIP_TRANSFER_US; first += 503) {
+            for (int64_t gap = 0; gap < 2 * LED_STRIP_TRANSFER_US; gap += 251) {
+                led_mode_request_t cmds[MAX_COMMANDS] = {
+                    { .mode = s_modes[from], .t_us = 50000 + first },
+                    { .mode = to, .t_us = 50000 + first + gap },
+                };
+                run_switch(s_modes[from], cmds, MAX_COMMANDS);
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    test_mode_lookup();
+    test_init_resets_state();
+    compute_first_frames();
+    test_switch_latency();
+    test_switch_after_reselect();
+
+    if (s_failures) {
+        printf("%d check(s) failed\n", s_failures);
+        return 1;
+    }
+    printf("All LED effect tests passed\n");
+    return 0;
+}
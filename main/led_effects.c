@@ -0,0 +1,472 @@
+#include <string.h>
+#include "led_effects.h"
+
+void led_strip_hsv2rgb(uint32_t h, uint32_t s, uint32_t v, uint32_t *r, uint32_t *g, uint32_t *b)
+{
+    h %= 360; // h -> [0,360]
+    uint32_t rgb_max = v * 2.55f;
+    uint32_t rgb_min = rgb_max * (100 - s) / 100.0f;
+
+    uint32_t i = h / 60;
+    uint32_t diff = h % 60;
+
+    // RGB adjustment amount by hue
+    uint32_t rgb_adj = (rgb_max - rgb_min) * diff / 60;
+
+    switch (i) {
+    case 0:
+        *r = rgb_max;
+        *g = rgb_min + rgb_adj;
+        *b = rgb_min;
+        break;
+    case 1:
+        *r = rgb_max - rgb_adj;
+        *g = rgb_max;
+        *b = rgb_min;
+        break;
+    case 2:
+        *r = rgb_min;
+        *g = rgb_max;
+        *b = rgb_min + rgb_adj;
+        break;
+    case 3:
+        *r = rgb_min;
+        *g = rgb_max - rgb_adj;
+        *b = rgb_max;
+        break;
+    case 4:
+        *r = rgb_min + rgb_adj;
+        *g = rgb_min;
+        *b = rgb_max;
+        break;
+    default:
+        *r = rgb_max;
+        *g = rgb_min;
+        *b = rgb_max - rgb_adj;
+        break;
+    }
+}
+
+/* ---------------- Mode 0: OFF ---------------- */
+
+static void off_init(void)
+{
+}
+
+static uint32_t off_step(uint8_t *pixels)
+{
+    memset(pixels, 0, LED_NUMBER * 3);
+    return 100;
+}
+
+/* ---------------- Mode 1: RAINBOW ---------------- */
+
+static struct {
+    int sub_frame;      // which third of the strip gets refreshed this frame
+    uint16_t start_rgb;
+} rainbow;
+
+static void rainbow_init(void)
+{
+    rainbow.sub_frame = 0;
+    rainbow.start_rgb = 0;
+}
+
+static uint32_t rainbow_step(uint8_t *pixels)
+{
+    uint32_t red = 0, green = 0, blue = 0;
+    for (int j = rainbow.sub_frame; j < LED_NUMBER; j += 3) {
+        uint16_t hue = j * 360 / LED_NUMBER + rainbow.start_rgb;
+        led_strip_hsv2rgb(hue, 100, 10, &red, &green, &blue);
+        // Correct GRB mapping for WS2812B (it is a bit different than usual with the order)
+        pixels[j * 3 + 0] = green;  // Hardware expects Green first
+        pixels[j * 3 + 1] = red;    // Hardware expects Red second
+        pixels[j * 3 + 2] = blue;   // Hardware expects Blue third
+    }
+    // Each step is one of the three interleaved sub-frames; the hue only moves after all three
+    if (++rainbow.sub_frame == 3) {
+        rainbow.sub_frame = 0;
+        rainbow.start_rgb += 60;
+    }
+    return 10;
+}
+
+/* ---------------- Mode 7: WATERLOO CHASE (Black & Gold) ---------------- */
+
+static int waterloo_offset;
+
+static void waterloo_init(void)
+{
+    waterloo_offset = 0;
+}
+
+static uint32_t waterloo_step(uint8_t *pixels)
+{
+    for (int j = 0; j < LED_NUMBER; j++) {
+        if ((j + waterloo_offset) % 10 < 5) {
+            pixels[j * 3 + 0] = 30;  // Green (Gold needs G+R)
+            pixels[j * 3 + 1] = 50;  // Red
+            pixels[j * 3 + 2] = 0;   // Blue
+        } else {
+            pixels[j * 3 + 0] = 0;   // Black
+            pixels[j * 3 + 1] = 0;
+            pixels[j * 3 + 2] = 0;
+        }
+    }
+    waterloo_offset++;
+    return 50;
+}
+
+/* ---------------- Mode 8: BREATHING PULSE ---------------- */
+
+static struct {
+    int brightness;
+    int direction;
+} breathing;
+
+static void breathing_init(void)
+{
+    breathing.brightness = 0;
+    breathing.direction = 1;
+}
+
+static uint32_t breathing_step(uint8_t *pixels)
+{
+    for (int j = 0; j < LED_NUMBER; j++) {
+        pixels[j * 3 + 0] = 0;                    // Green
+        pixels[j * 3 + 1] = breathing.brightness; // Red
+        pixels[j * 3 + 2] = breathing.brightness; // Blue (Makes Purple/Pink)
+    }
+    breathing.brightness += breathing.direction;
+    if (breathing.brightness >= 50 || breathing.brightness <= 0) breathing.direction *= -1;
+    return 20;
+}
+
+/* ---------------- Mode 9: SPARKLE (Twinkling Stars) ---------------- */
+
+static int sparkle_counter;
+
+static void sparkle_init(void)
+{
+    sparkle_counter = 0;
+}
+
+static uint32_t sparkle_step(uint8_t *pixels)
+{
+    memset(pixels, 0, LED_NUMBER * 3);
+
+    // Create random sparkles
+    for (int j = 0; j < LED_NUMBER; j++) {
+        // Pseudo-random based on position and counter
+        int random_val = (j * 73 + sparkle_counter * 97) % 256;
+        if (random_val < 30) { // 30/256 chance of sparkle
+            pixels[j * 3 + 0] = 50;  // Green-ish White
+            pixels[j * 3 + 1] = 50;  // Red
+            pixels[j * 3 + 2] = 50;  // Blue
+        }
+    }
+    sparkle_counter++;
+    return 100;
+}
+
+/* ---------------- Mode 10: FIRE EFFECT ---------------- */
+
+static int fire_offset;
+
+static void fire_init(void)
+{
+    fire_offset = 0;
+}
+
+static uint32_t fire_step(uint8_t *pixels)
+{
+    for (int j = 0; j < LED_NUMBER; j++) {
+        int flicker = (j * 29 + fire_offset * 17) % 256;
+        int red_intensity, green_intensity;
+        if (flicker > 200) {
+            // Hot part - bright yellow/orange
+            red_intensity = 50;
+            green_intensity = 40;
+        } else if (flicker > 130) {
+            // Orange flames
+            red_intensity = 50;
+            green_intensity = 25;
+        } else if (flicker > 60) {
+            // Deep orange/red
+            red_intensity = 45;
+            green_intensity = 15;
+        } else {
+            // Dark red coals
+            red_intensity = 35;
+            green_intensity = 5;
+        }
+
+        pixels[j * 3 + 0] = green_intensity;  // Green
+        pixels[j * 3 + 1] = red_intensity;    // Red
+        pixels[j * 3 + 2] = 0; // no blue
+    }
+    fire_offset++;
+    return 30;
+}
+
+/* ---------------- Mode 11: NEON STRIPES ---------------- */
+
+static int stripe_offset;
+
+static void stripes_init(void)
+{
+    stripe_offset = 0;
+}
+
+static uint32_t stripes_step(uint8_t *pixels)
+{
+    for (int j = 0; j < LED_NUMBER; j++) {
+        int stripe_pos = (j + stripe_offset) % 20;
+        if (stripe_pos < 10) {
+            // Cyan stripe
+            pixels[j * 3 + 0] = 50;  // Green
+            pixels[j * 3 + 1] = 0;   // Red
+            pixels[j * 3 + 2] = 50;  // Blue
+        } else {
+            // Magenta stripe
+            pixels[j * 3 + 0] = 0;   // Green
+            pixels[j * 3 + 1] = 50;  // Red
+            pixels[j * 3 + 2] = 50;  // Blue
+        }
+    }
+    stripe_offset++;
+    return 40;
+}
+
+/* ---------------- Mode 12: LIGHTNING BOLT ---------------- */
+
+static int bolt_position;
+
+static void lightning_init(void)
+{
+    bolt_position = 0;
+}
+
+static uint32_t lightning_step(uint8_t *pixels)
+{
+    memset(pixels, 0, LED_NUMBER * 3);
+
+    // Create a moving bright bolt
+    int bolt_width = 15;
+    for (int j = 0; j < LED_NUMBER; j++) {
+        int distance = j - bolt_position;
+        if (distance >= 0 && distance < bolt_width) {
+            int brightness = 50 - (distance * 50 / bolt_width);
+            pixels[j * 3 + 0] = brightness;  // Green (white bolt)
+            pixels[j * 3 + 1] = brightness;  // Red
+            pixels[j * 3 + 2] = brightness;  // Blue
+        }
+    }
+
+    bolt_position += 2;
+    if (bolt_position > LED_NUMBER + 15) {
+        bolt_position = -15;
+    }
+    return 20;
+}
+
+/* ---------------- Mode 13: CHRISTMAS (Red & Green Chasing) ---------------- */
+
+static int xmas_offset;
+
+static void xmas_init(void)
+{
+    xmas_offset = 0;
+}
+
+static uint32_t xmas_step(uint8_t *pixels)
+{
+    for (int j = 0; j < LED_NUMBER; j++) {
+        if ((j + xmas_offset) % 12 < 6) {
+            // Red LED
+            pixels[j * 3 + 0] = 0;   // Green
+            pixels[j * 3 + 1] = 50;  // Red
+            pixels[j * 3 + 2] = 0;   // Blue
+        } else {
+            // Green LED
+            pixels[j * 3 + 0] = 50;  // Green
+            pixels[j * 3 + 1] = 0;   // Red
+            pixels[j * 3 + 2] = 0;   // Blue
+        }
+    }
+    xmas_offset++;
+    return 60;
+}
+
+/* ---------------- Mode 14: HAPPY NEW YEAR (Gold & Silver with Sparkle) ---------------- */
+
+static struct {
+    int counter;
+    int brightness;
+    int direction;
+} newyear;
+
+static void newyear_init(void)
+{
+    newyear.counter = 0;
+    newyear.brightness = 0;
+    newyear.direction = 1;
+}
+
+static uint32_t newyear_step(uint8_t *pixels)
+{
+    for (int j = 0; j < LED_NUMBER; j++) {
+        // Pseudo-random sparkle for festive look
+        int sparkle_val = (j * 67 + newyear.counter * 43) % 256;
+
+        // Base gold/silver stripe pattern
+        if ((j + newyear.counter / 20) % 20 < 10) {
+            // Gold (Red + Green)
+            pixels[j * 3 + 0] = (sparkle_val < 40) ? newyear.brightness + 20 : 25;  // Green
+            pixels[j * 3 + 1] = (sparkle_val < 40) ? newyear.brightness + 30 : 40;  // Red
+            pixels[j * 3 + 2] = 0;   // Blue
+        } else {
+            // Silver (White)
+            pixels[j * 3 + 0] = (sparkle_val < 30) ? newyear.brightness + 15 : 30;  // Green
+            pixels[j * 3 + 1] = (sparkle_val < 30) ? newyear.brightness + 15 : 30;  // Red
+            pixels[j * 3 + 2] = (sparkle_val < 30) ? newyear.brightness + 15 : 30;  // Blue
+        }
+    }
+
+    // Pulsing brightness for celebration effect
+    newyear.brightness += newyear.direction * 2;
+    if (newyear.brightness >= 30 || newyear.brightness <= 0) {
+        newyear.direction *= -1;
+    }
+
+    newyear.counter++;
+    return 25;
+}
+
+/* ---------------- Mode 15: My FAVORITE - Collision Waves to Fireworks ---------------- */
+
+static struct {
+    float pos_left;         // LED from left moving right
+    float pos_right;        // LED from right moving left
+    int collision_count;    // How many times they've collided
+    int fireworks_mode;     // 0 = collision phase, 1 = fireworks
+    int fireworks_counter;
+} favorite;
+
+static void favorite_init(void)
+{
+    favorite.pos_left = -10;                // start off-screen
+    favorite.pos_right = LED_NUMBER + 10;   // start off-screen
+    favorite.collision_count = 0;
+    favorite.fireworks_mode = 0;
+    favorite.fireworks_counter = 0;
+}
+
+static uint32_t favorite_step(uint8_t *pixels)
+{
+    memset(pixels, 0, LED_NUMBER * 3);
+
+    if (favorite.fireworks_mode == 0) {
+        // COLLISION PHASE - Two dots moving towards each other
+        int left_pos = (int)favorite.pos_left;
+        int right_pos = (int)favorite.pos_right;
+
+        if (left_pos >= 0 && left_pos < LED_NUMBER) {
+            pixels[left_pos * 3 + 0] = 20;  // Green
+            pixels[left_pos * 3 + 1] = 50;  // Red
+            pixels[left_pos * 3 + 2] = 40;  // Blue (magenta)
+        }
+
+        if (right_pos >= 0 && right_pos < LED_NUMBER) {
+            pixels[right_pos * 3 + 0] = 50;  // Green
+            pixels[right_pos * 3 + 1] = 0;   // Red
+            pixels[right_pos * 3 + 2] = 50;  // Blue (cyan)
+        }
+
+        favorite.pos_left += 1.5;
+        favorite.pos_right -= 1.5;
+
+        // Check for collision (when they meet in the middle)
+        if (favorite.pos_left >= favorite.pos_right && favorite.collision_count == 0) {
+            favorite.collision_count = 1;
+            favorite.pos_left = LED_NUMBER / 2 - 15;
+            favorite.pos_right = LED_NUMBER / 2 + 15;
+        }
+        else if (favorite.collision_count > 0) {
+            for (int j = (int)favorite.pos_left; j <= (int)favorite.pos_right && j < LED_NUMBER; j++) {
+                if (j >= 0) {
+                    pixels[j * 3 + 0] = 25;   // Green
+                    pixels[j * 3 + 1] = 35;   // Red
+                    pixels[j * 3 + 2] = 35;   // Blue
+                }
+            }
+
+            favorite.pos_left -= 2.0;
+            favorite.pos_right += 2.0;
+            favorite.collision_count++;
+        }
+
+        // After expanding enough, go to fireworks
+        if (favorite.collision_count > 30) {
+            favorite.fireworks_mode = 1;
+            favorite.fireworks_counter = 0;
+        }
+    }
+    else if (favorite.fireworks_mode == 1) {
+        // FIREWORKS PHASE - Random bursts of color
+        for (int j = 0; j < LED_NUMBER; j++) {
+            int burst = (j * 73 + favorite.fireworks_counter * 91) % 256;
+
+            if (burst < 80) {
+                // Bright burst
+                int color_type = (j + favorite.fireworks_counter) % 3;
+                if (color_type == 0) {
+                    // Magenta
+                    pixels[j * 3 + 0] = 20;
+                    pixels[j * 3 + 1] = 50;
+                    pixels[j * 3 + 2] = 40;
+                } else if (color_type == 1) {
+                    // Cyan
+                    pixels[j * 3 + 0] = 50;
+                    pixels[j * 3 + 1] = 0;
+                    pixels[j * 3 + 2] = 50;
+                } else {
+                    // Yellow
+                    pixels[j * 3 + 0] = 40;
+                    pixels[j * 3 + 1] = 50;
+                    pixels[j * 3 + 2] = 0;
+                }
+            }
+        }
+        favorite.fireworks_counter++;
+    }
+    return 40;
+}
+
+/* Mode numbers match the /mode?m=X links on the web dashboard */
+static const struct {
+    int mode;
+    led_effect_t effect;
+} s_effects[] = {
+    { 0,  { "off",       off_init,       off_step } },
+    { 1,  { "rainbow",   rainbow_init,   rainbow_step } },
+    { 7,  { "waterloo",  waterloo_init,  waterloo_step } },
+    { 8,  { "breathing", breathing_init, breathing_step } },
+    { 9,  { "sparkle",   sparkle_init,   sparkle_step } },
+    { 10, { "fire",      fire_init,      fire_step } },
+    { 11, { "stripes",   stripes_init,   stripes_step } },
+    { 12, { "lightning", lightning_init, lightning_step } },
+    { 13, { "christmas", xmas_init,      xmas_step } },
+    { 14, { "new_year",  newyear_init,   newyear_step } },
+    { 15, { "favorite",  favorite_init,  favorite_step } },
+};
+
+const led_effect_t *led_effect_get(int mode)
+{
+    for (size_t i = 0; i < sizeof(s_effects) / sizeof(s_effects[0]); i++) {
+        if (s_effects[i].mode == mode) {
+            return &s_effects[i].effect;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_NUMBER         300
+
+/**
+ * @brief One LED animation, driven one frame at a time by the render loop
+ *
+ * Effects keep no hidden state between modes: the render loop calls init() when
+ * switching to an effect (reset) and only step() while it stays selected (resume).
+ * step() never blocks, so a new mode can be picked up after any single frame.
+ */
+typedef struct {
+    const char *name;
+    void (*init)(void);                 /*!< Reset the effect to its first frame */
+    uint32_t (*step)(uint8_t *pixels);  /*!< Render one GRB frame, return ms until the next one */
+} led_effect_t;
+
+// returns the effect for a web dashboard mode number, or NULL if the mode is unknown
+const led_effect_t *led_effect_get(int mode);
+
+void led_strip_hsv2rgb(uint32_t h, uint32_t s, uint32_t v, uint32_t *r, uint32_t *g, uint32_t *b);
+
+#ifdef __cplusplus
+}
+#endif
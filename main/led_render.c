@@ -0,0 +1,76 @@
+#include <string.h>
+#include "led_render.h"
+
+void led_renderer_init(led_renderer_t *renderer, const led_render_io_t *io, int mode)
+{
+    memset(renderer, 0, sizeof(*renderer));
+    renderer->io = io;
+    renderer->mode = mode;
+    renderer->effect = led_effect_get(mode);
+    renderer->effect->init();
+}
+
+static void switch_mode(led_renderer_t *renderer, const led_mode_request_t *req)
+{
+    // Re-selecting the running mode just resumes it where it was
+    if (req->mode == renderer->mode) {
+        return;
+    }
+    const led_effect_t *effect = led_effect_get(req->mode);
+    if (effect == NULL) {
+        return;
+    }
+    // Switching modes always restarts the effect from its first frame
+    renderer->mode = req->mode;
+    renderer->effect = effect;
+    renderer->effect->init();
+    renderer->switched = true;
+    renderer->request_us = req->t_us;
+}
+
+static uint32_t render(led_renderer_t *renderer)
+{
+    uint8_t *back = renderer->buffers[renderer->back];
+    if (renderer->switched) {
+        // Rainbow only repaints a third of the strip per frame, so drop the old mode's pixels
+        memset(back, 0, sizeof(renderer->buffers[0]));
+    } else {
+        // Effects draw on top of the last frame, same as with a single buffer
+        memcpy(back, renderer->buffers[renderer->back ^ 1], sizeof(renderer->buffers[0]));
+    }
+    renderer->frames_rendered++;
+    return renderer->effect->step(back);
+}
+
+void led_renderer_run_once(led_renderer_t *renderer)
+{
+    const led_render_io_t *io = renderer->io;
+    led_mode_request_t req;
+
+    uint32_t frame_ms = render(renderer);
+
+    // The previous frame is still going out; once it is done, its buffer is free for the next render
+    io->wait_done(io->ctx);
+
+    // A command that came in meanwhile makes this frame stale, so draw the new mode instead
+    if (io->wait_request(io->ctx, 0, &req)) {
+        switch_mode(renderer, &req);
+        if (renderer->switched) {
+            frame_ms = render(renderer);
+        }
+    }
+
+    io->transmit(io->ctx, renderer->buffers[renderer->back], sizeof(renderer->buffers[0]));
+    renderer->back ^= 1;
+
+    if (renderer->switched) {
+        io->wait_done(io->ctx);
+        io->report_switch(io->ctx, renderer->mode, io->now_us(io->ctx) - renderer->request_us, frame_ms);
+        renderer->switched = false;
+    }
+
+    // Sleep until the next frame is due, or wake right away on a mode command
+    if (io->wait_request(io->ctx, frame_ms, &req)) {
+        switch_mode(renderer, &req);
+    }
+}
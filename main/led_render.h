@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "led_effects.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// WS2812B: 24 bits x 1.25us per LED, then the 50us reset code the encoder appends
+#define LED_STRIP_TRANSFER_US   (LED_NUMBER * 30 + 50)
+
+// A frame that is already on the wire has to finish before the new one can follow it,
+// so a mode switch shows up on the strip within one frame period plus one transfer
+#define LED_SWITCH_BOUND_US(frame_ms)   ((int64_t)(frame_ms) * 1000 + LED_STRIP_TRANSFER_US)
+
+/**
+ * @brief A mode command from the web server, stamped when it came in
+ */
+typedef struct {
+    int mode;
+    int64_t t_us;
+} led_mode_request_t;
+
+/**
+ * @brief Hooks that connect the renderer to the RTOS and the LED driver
+ */
+typedef struct {
+    void *ctx;
+    // Wait up to timeout_ms for a mode command (0 = just check); true if *req was filled in
+    bool (*wait_request)(void *ctx, uint32_t timeout_ms, led_mode_request_t *req);
+    // Queue a frame for sending; the buffer must stay untouched until wait_done() returns
+    void (*transmit)(void *ctx, const uint8_t *pixels, size_t size);
+    // Block until every queued frame is on the strip
+    void (*wait_done)(void *ctx);
+    int64_t (*now_us)(void *ctx);
+    // Called once the first frame of a new mode is on the strip
+    void (*report_switch)(void *ctx, int mode, int64_t latency_us, uint32_t frame_ms);
+} led_render_io_t;
+
+/**
+ * @brief Render loop state
+ *
+ * Frames are double buffered: the next frame is rendered while the previous one is still
+ * being sent, so a mode switch never waits on the old frame before drawing the new one.
+ */
+typedef struct {
+    const led_render_io_t *io;
+    uint8_t buffers[2][LED_NUMBER * 3];
+    int back;                       // buffer the next frame is rendered into
+    int mode;
+    const led_effect_t *effect;
+    bool switched;                  // first frame of a new mode is due
+    int64_t request_us;             // when the command for the current mode came in
+    uint32_t frames_rendered;
+} led_renderer_t;
+
+// mode must be a known effect (see led_effect_get)
+void led_renderer_init(led_renderer_t *renderer, const led_render_io_t *io, int mode);
+
+// Render and send one frame, then sleep until the next one is due or a mode command arrives
+void led_renderer_run_once(led_renderer_t *renderer);
+
+#ifdef __cplusplus
+}
+#endif